@@ -0,0 +1,33 @@
+#!/bin/bash
+# Benchmarks project3 at increasing trace sizes. For each workload, times
+# parsing, then simulation and output for each policy, and reports jobs/sec and
+# peak memory (KB). The vertical timeline grows with time * jobs, so it is only
+# timed up to max-timeline-jobs (0 for no limit), while the segment list output
+# is timed at every size.
+# Usage: ./benchmark.sh [max-jobs] [text|binary] [max-timeline-jobs]
+set -e
+
+MAX_JOBS=${1:-1000000}
+FORMAT=${2:-binary}
+MAX_TIMELINE_JOBS=${3:-20000}
+WORKLOADS=("poisson exponential" "bursty pareto")
+
+cd "$(dirname "$0")"
+gcc -O2 -o project3 project3.c
+gcc -O2 -o jobgen jobgen.c -lm
+
+TRACE_DIR=$(mktemp -d)
+trap 'rm -rf "$TRACE_DIR"' EXIT
+
+printf "%-8s %-12s %-8s %s\n" "arrival" "duration" "format" \
+  "$(./project3 -b /dev/null | head -n 1)"
+for ((jobs = 100; jobs <= MAX_JOBS; jobs *= 10)); do
+  for workload in "${WORKLOADS[@]}"; do
+    read -r arrival duration <<<"$workload"
+    trace="$TRACE_DIR/$arrival-$duration-$jobs"
+    ./jobgen -n "$jobs" -a "$arrival" -d "$duration" -f "$FORMAT" -o "$trace"
+    ./project3 -b "$trace" "$MAX_TIMELINE_JOBS" | tail -n +2 | while read -r row; do
+      printf "%-8s %-12s %-8s %s\n" "$arrival" "$duration" "$FORMAT" "$row"
+    done
+  done
+done
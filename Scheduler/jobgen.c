@@ -0,0 +1,300 @@
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Binary job file layout, must match project3.c
+#define BINARY_MAGIC "\x7fJOB"
+#define BINARY_MAGIC_LEN 4
+#define BINARY_RECORD_SIZE 9
+
+// Bursty arrivals come in groups of this many jobs on average, spaced this
+// many times closer than the overall mean inter-arrival time
+#define BURST_SIZE 32
+#define BURST_SPREAD 8.0
+
+// Heavy-tailed durations are capped so one extreme draw cannot stall the rest
+// of the trace. Only arrival times have to fit in 32 bits, since project3 keeps
+// completion times in 64 bits however much work is queued.
+#define MAX_DURATION 1000000
+
+// Output buffer size so tens of millions of lines are written in big chunks
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+enum Arrival { ARRIVAL_POISSON, ARRIVAL_BURSTY };
+enum Distribution { DURATION_EXPONENTIAL, DURATION_PARETO };
+enum Format { FORMAT_TEXT, FORMAT_BINARY };
+
+struct Options {
+  unsigned long count;
+  enum Arrival arrival;
+  double mean_interarrival;
+  enum Distribution distribution;
+  double mean_duration;
+  double pareto_alpha;
+  enum Format format;
+  unsigned long long seed;
+  char *output_path;
+};
+
+int parse_options(int argc, char *argv[], struct Options *options);
+int parse_integer(char *text, unsigned long long max,
+                  unsigned long long *value);
+int parse_real(char *text, double *value);
+double next_uniform(unsigned long long *state);
+double next_exponential(unsigned long long *state, double mean);
+unsigned int next_duration(unsigned long long *state, struct Options *options);
+void write_job(FILE *out, enum Format format, char name,
+               unsigned int arrival_time, unsigned int duration);
+
+/**
+ * Main function. Generates a job file for project3 with the requested arrival
+ * process and duration distribution.
+ */
+int main(int argc, char *argv[]) {
+  struct Options options = {
+      1000, ARRIVAL_POISSON, 5.0, DURATION_EXPONENTIAL, 4.0, 1.5,
+      FORMAT_TEXT, 1, NULL,
+  };
+  if (parse_options(argc, argv, &options) != 0) {
+    printf("Usage: %s [-n count] [-a poisson|bursty] [-r mean-interarrival]\n"
+           "       [-d exponential|pareto] [-m mean-duration] [-k "
+           "pareto-alpha]\n"
+           "       [-f text|binary] [-s seed] [-o output-file]\n",
+           argv[0]);
+    return 1;
+  }
+
+  FILE *out = stdout;
+  if (options.output_path != NULL &&
+      (out = fopen(options.output_path, "wb")) == NULL) {
+    printf("Failed to open file: %s\n", options.output_path);
+    return -1;
+  }
+  setvbuf(out, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+  if (options.format == FORMAT_BINARY) {
+    fwrite(BINARY_MAGIC, 1, BINARY_MAGIC_LEN, out);
+  }
+
+  // Arrivals accumulate as real numbers and are truncated when written, so
+  // several jobs can share an arrival time
+  unsigned long long rng = options.seed;
+  double time = 0;
+  unsigned long burst_left = 0;
+  int res = 0;
+  for (unsigned long i = 0; i < options.count; i++) {
+    if (i > 0) {
+      if (options.arrival == ARRIVAL_POISSON) {
+        time += next_exponential(&rng, options.mean_interarrival);
+      } else if (burst_left > 0) {
+        time += next_exponential(&rng, options.mean_interarrival / BURST_SPREAD);
+        burst_left--;
+      } else {
+        // The quiet gap makes up the time saved inside the burst, so the
+        // overall arrival rate matches the Poisson case
+        time += next_exponential(&rng, BURST_SIZE * options.mean_interarrival *
+                                           (1 - 1 / BURST_SPREAD));
+        burst_left = (unsigned long)next_exponential(&rng, BURST_SIZE);
+      }
+    }
+
+    // Report on stderr since stdout may be the trace itself
+    if (time > UINT_MAX) {
+      fprintf(stderr, "Arrival time overflow after %lu jobs.\n", i);
+      res = 1;
+      break;
+    }
+
+    write_job(out, options.format, 'A' + i % 26, (unsigned int)time,
+              next_duration(&rng, &options));
+  }
+
+  if (out != stdout) {
+    fclose(out);
+  } else {
+    fflush(out);
+  }
+  return res;
+}
+
+/**
+ * Parse command line options into options. Returns 0 for success or -1 for an
+ * invalid option.
+ */
+int parse_options(int argc, char *argv[], struct Options *options) {
+  int opt;
+  unsigned long long count;
+  while ((opt = getopt(argc, argv, "n:a:r:d:m:k:f:s:o:")) != -1) {
+    switch (opt) {
+    case 'n':
+      if (parse_integer(optarg, ULONG_MAX, &count) != 0) {
+        return -1;
+      }
+      options->count = count;
+      break;
+    case 'a':
+      if (strcmp(optarg, "poisson") == 0) {
+        options->arrival = ARRIVAL_POISSON;
+      } else if (strcmp(optarg, "bursty") == 0) {
+        options->arrival = ARRIVAL_BURSTY;
+      } else {
+        return -1;
+      }
+      break;
+    case 'r':
+      if (parse_real(optarg, &options->mean_interarrival) != 0) {
+        return -1;
+      }
+      break;
+    case 'd':
+      if (strcmp(optarg, "exponential") == 0) {
+        options->distribution = DURATION_EXPONENTIAL;
+      } else if (strcmp(optarg, "pareto") == 0) {
+        options->distribution = DURATION_PARETO;
+      } else {
+        return -1;
+      }
+      break;
+    case 'm':
+      if (parse_real(optarg, &options->mean_duration) != 0) {
+        return -1;
+      }
+      break;
+    case 'k':
+      if (parse_real(optarg, &options->pareto_alpha) != 0) {
+        return -1;
+      }
+      break;
+    case 'f':
+      if (strcmp(optarg, "text") == 0) {
+        options->format = FORMAT_TEXT;
+      } else if (strcmp(optarg, "binary") == 0) {
+        options->format = FORMAT_BINARY;
+      } else {
+        return -1;
+      }
+      break;
+    case 's':
+      if (parse_integer(optarg, ULLONG_MAX, &options->seed) != 0) {
+        return -1;
+      }
+      break;
+    case 'o':
+      options->output_path = optarg;
+      break;
+    default:
+      return -1;
+    }
+  }
+
+  // Pareto needs alpha > 1 for the mean to exist
+  if (optind != argc || options->mean_interarrival < 0 ||
+      options->mean_duration < 1 || options->pareto_alpha <= 1) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Parse a whole option value as a decimal integer up to max. Returns 0 for
+ * success or -1 if it is not a number or out of range.
+ */
+int parse_integer(char *text, unsigned long long max,
+                  unsigned long long *value) {
+  // strtoull accepts a sign and wraps negative numbers, so require a digit
+  if (!isdigit((unsigned char)text[0])) {
+    return -1;
+  }
+
+  char *end;
+  errno = 0;
+  *value = strtoull(text, &end, 10);
+  if (errno != 0 || *end != '\0' || *value > max) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Parse a whole option value as a finite real number. Returns 0 for success or
+ * -1 if it is not a number or out of range.
+ */
+int parse_real(char *text, double *value) {
+  char *end;
+  errno = 0;
+  *value = strtod(text, &end);
+  if (end == text || errno != 0 || *end != '\0' || !isfinite(*value)) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Returns a uniform number in (0, 1) using splitmix64, so the same seed always
+ * produces the same trace regardless of the C library.
+ */
+double next_uniform(unsigned long long *state) {
+  unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return ((z >> 11) + 0.5) / 9007199254740992.0; // 2^53
+}
+
+/**
+ * Returns an exponentially distributed number with the given mean.
+ */
+double next_exponential(unsigned long long *state, double mean) {
+  return -mean * log(next_uniform(state));
+}
+
+/**
+ * Returns a job duration of at least 1 from the configured distribution.
+ */
+unsigned int next_duration(unsigned long long *state, struct Options *options) {
+  double duration;
+  if (options->distribution == DURATION_EXPONENTIAL) {
+    duration = next_exponential(state, options->mean_duration);
+  } else {
+    // Pareto scale chosen so the distribution mean is mean_duration
+    double alpha = options->pareto_alpha;
+    double scale = options->mean_duration * (alpha - 1) / alpha;
+    duration = scale / pow(next_uniform(state), 1 / alpha);
+  }
+
+  if (duration < 1) {
+    return 1;
+  } else if (duration > MAX_DURATION) {
+    return MAX_DURATION;
+  }
+  return (unsigned int)duration;
+}
+
+/**
+ * Write one job as a text line or binary record.
+ */
+void write_job(FILE *out, enum Format format, char name,
+               unsigned int arrival_time, unsigned int duration) {
+  if (format == FORMAT_TEXT) {
+    fprintf(out, "%c\t%u\t%u\n", name, arrival_time, duration);
+    return;
+  }
+
+  unsigned char record[BINARY_RECORD_SIZE] = {
+      (unsigned char)name,
+      arrival_time & 0xFF,
+      (arrival_time >> 8) & 0xFF,
+      (arrival_time >> 16) & 0xFF,
+      arrival_time >> 24,
+      duration & 0xFF,
+      (duration >> 8) & 0xFF,
+      (duration >> 16) & 0xFF,
+      duration >> 24,
+  };
+  fwrite(record, 1, BINARY_RECORD_SIZE, out);
+}
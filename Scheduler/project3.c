@@ -1,6 +1,46 @@
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
 
-#define MAX_JOBS 100
+// Starting capacity of the job and segment arrays. They double when full
+#define INITIAL_CAPACITY 128
+
+// Binary job files (see jobgen.c) start with this magic, followed by
+// fixed-size records: 1 byte name, then little-endian arrival and duration.
+// The first byte is never used as a job name, so one byte of lookahead is
+// enough to tell the formats apart.
+#define BINARY_MAGIC "\x7fJOB"
+#define BINARY_MAGIC_LEN 4
+#define BINARY_RECORD_SIZE 9
+#define BINARY_CHUNK_RECORDS 4096
+
+// Longest text job line, which is far more than a name and two numbers need
+#define MAX_LINE_LENGTH 256
+
+// Checkpoint files are a machine-local cache written next to the trace. They
+// start with their own magic and are ignored if it does not match. A
+// checkpoint is taken after this many newly admitted jobs, plus the number of
+// queued jobs it has to store, so their total size stays linear in the trace.
+#define CHECKPOINT_MAGIC "\x7f" "CKP"
+#define CHECKPOINT_MAGIC_LEN 4
+#define CHECKPOINT_SUFFIX ".ckpt"
+#define CHECKPOINT_INTERVAL 4096
+
+// FNV-1a parameters used to hash the jobs covered by each checkpoint
+#define HASH_SEED 0xCBF29CE484222325ULL
+#define HASH_PRIME 0x100000001B3ULL
+
+// Every timeline line is padded by the job index, so the printed timeline grows
+// with time * jobs. Benchmark mode only times it up to this many jobs unless
+// told otherwise, but always times the segment list, which grows linearly.
+#define BENCH_MAX_TIMELINE_JOBS 20000
 
 struct Job {
   char name;
@@ -8,185 +48,1422 @@ struct Job {
   unsigned int duration;
 };
 
-int read_jobs(char *path, struct Job *jobs, unsigned int *job_count);
-void fcfs(struct Job *jobs, unsigned int count);
-void round_robin(struct Job *jobs, unsigned int count);
+// A contiguous run of one job on the CPU. Time is 64-bit since a long or
+// overloaded trace can finish well after the last 32-bit arrival time. start
+// comes first so the struct stays 16 bytes.
+struct Segment {
+  unsigned long long start;
+  unsigned int job;
+  unsigned int length;
+};
+
+// Result of a scheduling policy. Segments are in increasing start order. end
+// is when the last job finished, which is after the last segment if jobs with
+// no duration arrive later.
+struct Schedule {
+  struct Segment *segments;
+  unsigned int count;
+  unsigned int capacity;
+  unsigned long long end;
+};
+
+// Progress of a Round Robin simulation. The queue is a circular array of job
+// indexes and durations holds each job's remaining time.
+struct RoundRobinState {
+  unsigned int *durations;
+  unsigned int *queue;
+  unsigned int front, rear, queued;
+  unsigned int next_job, finished;
+  unsigned long long time;
+};
+
+// Simulation state saved periodically so an edited trace can resume from the
+// last point before its first change. Jobs from next_job on have not been
+// admitted yet, and must arrive at or after arrival_bound for the state to
+// still hold. job_hash covers jobs before next_job.
+struct Checkpoint {
+  unsigned long long time;
+  unsigned int next_job;
+  unsigned int finished;
+  unsigned long long arrival_bound;
+  unsigned long long job_hash;
+  // Schedule length at this point. The last segment may have grown later.
+  unsigned int segment_count;
+  unsigned int last_length;
+  // Round Robin queue contents, stored in Checkpoints.queued_jobs
+  unsigned int queue_offset;
+  unsigned int queued;
+};
+
+// A queued Round Robin job and its remaining duration
+struct QueuedJob {
+  unsigned int job;
+  unsigned int remaining;
+};
+
+// Growable list of checkpoints for one policy, in increasing time order
+struct Checkpoints {
+  struct Checkpoint *items;
+  unsigned int count;
+  unsigned int capacity;
+  struct QueuedJob *queued_jobs;
+  unsigned int queued_count;
+  unsigned int queued_capacity;
+};
+
+// A job in streaming mode that has arrived but not finished yet
+struct ActiveJob {
+  unsigned int id;
+  struct Job job;
+  unsigned int remaining;
+};
+
+// Growable circular queue of active jobs
+struct JobQueue {
+  struct ActiveJob *items;
+  unsigned int front, count, capacity;
+};
+
+// Progress of a streaming simulation. Only unfinished jobs are kept, so memory
+// depends on how many jobs are active rather than the trace length.
+struct Stream {
+  FILE *out;
+  struct JobQueue ready;
+  unsigned long long time;
+  unsigned int last_arrival;
+  // Round Robin job that just ran, waiting for arrivals before re-enqueueing
+  struct ActiveJob held;
+  int has_held;
+  // Segment not printed yet, so consecutive quanta of one job are merged
+  struct Segment open;
+  char open_name;
+  int has_open;
+};
+
+// A scheduling policy simulates the jobs into a schedule and returns 0, or -4
+// if it runs out of memory. The schedule and checkpoints may hold a previous
+// run on an earlier version of the trace, in which case the simulation resumes
+// from the latest checkpoint that is still valid. In streaming mode, advance
+// runs the ready jobs as far as possible knowing that no job arrives before
+// limit.
+struct Policy {
+  char *name;
+  int (*simulate)(struct Job *jobs, unsigned int count,
+                  struct Schedule *schedule, struct Checkpoints *checkpoints);
+  int (*advance)(struct Stream *stream, unsigned long long limit);
+};
+
+int read_jobs(char *path, struct Job **jobs, unsigned int *job_count);
+int detect_format(FILE *job_file);
+int read_next_job(FILE *job_file, int binary, struct Job *job);
+int read_text_jobs(FILE *job_file, struct Job **jobs, unsigned int *job_count);
+int read_binary_jobs(FILE *job_file, struct Job **jobs,
+                     unsigned int *job_count);
+void decode_record(unsigned char *record, struct Job *job);
+int grow_array(void **items, unsigned int count, unsigned int *capacity,
+               size_t item_size);
+int add_job(struct Job **jobs, unsigned int *count, unsigned int *capacity,
+            struct Job new_job);
+int add_segment(struct Schedule *schedule, unsigned int job,
+                unsigned long long start, unsigned int length);
+unsigned long long hash_jobs(unsigned long long hash, struct Job *jobs,
+                             unsigned int count);
+int checkpoint_due(struct Checkpoints *checkpoints, unsigned int next_job,
+                   unsigned int queued);
+int add_checkpoint(struct Checkpoints *checkpoints, struct Job *jobs,
+                   struct Schedule *schedule, struct Checkpoint checkpoint);
+int resume_checkpoint(struct Job *jobs, unsigned int count,
+                      struct Schedule *schedule,
+                      struct Checkpoints *checkpoints,
+                      struct Checkpoint *resume);
+unsigned long long hash_bytes(unsigned long long hash, void *bytes,
+                              size_t size);
+int write_array(void *items, size_t item_size, unsigned int count,
+                FILE *file, unsigned long long *checksum);
+int read_array(void *items, size_t item_size, unsigned int count, FILE *file,
+               unsigned long long *checksum);
+int save_checkpoints(char *path, struct Schedule *schedules,
+                     struct Checkpoints *checkpoints);
+int load_checkpoints(char *path, struct Schedule *schedules,
+                     struct Checkpoints *checkpoints);
+int check_checkpoints(struct Schedule *schedule,
+                      struct Checkpoints *checkpoints);
+void free_checkpoints(struct Checkpoints *checkpoints);
+int fcfs(struct Job *jobs, unsigned int count, struct Schedule *schedule,
+         struct Checkpoints *checkpoints);
+int round_robin(struct Job *jobs, unsigned int count,
+                struct Schedule *schedule, struct Checkpoints *checkpoints);
+int save_round_robin_state(struct RoundRobinState *state, unsigned int count,
+                           struct Job *jobs, struct Schedule *schedule,
+                           struct Checkpoints *checkpoints);
+void enqueue_arrivals(struct RoundRobinState *state, struct Job *jobs,
+                      unsigned int count);
+void print_schedule(FILE *out, char *title, struct Job *jobs,
+                    unsigned int count, struct Schedule *schedule);
+int queue_push(struct JobQueue *queue, struct ActiveJob active);
+struct ActiveJob queue_pop(struct JobQueue *queue);
+void stream_run(struct Stream *stream, struct ActiveJob *active,
+                unsigned int length);
+void flush_segment(struct Stream *stream);
+void print_done(FILE *out, struct ActiveJob *active,
+                unsigned long long finish_time);
+int fcfs_advance(struct Stream *stream, unsigned long long limit);
+int round_robin_advance(struct Stream *stream, unsigned long long limit);
+int stream_jobs(char *path, struct Policy *policy);
+void print_error(int err_code, char *path);
+int parse_count(char *text, unsigned int *count);
+void print_segments(FILE *out, struct Job *jobs, struct Schedule *schedule);
+double elapsed_since(struct timespec start);
+void print_bench_row(char *phase, char *policy, unsigned int count,
+                     double seconds);
+int run_benchmark(char *path, unsigned int max_timeline_jobs);
+
+struct Policy policies[] = {
+    {"FCFS", fcfs, fcfs_advance},
+    {"RR", round_robin, round_robin_advance},
+};
+#define POLICY_COUNT (sizeof(policies) / sizeof(policies[0]))
 
 /**
  * Main function. Only orchestrates reading jobs, calling the scheduling, and
  * printing errors.
  */
 int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    printf("Usage: %s <job-file>\n", argv[0]);
+  unsigned int max_timeline_jobs = BENCH_MAX_TIMELINE_JOBS;
+  if ((argc == 3 || argc == 4) && strcmp(argv[1], "-b") == 0 &&
+      (argc == 3 || parse_count(argv[3], &max_timeline_jobs) == 0)) {
+    return run_benchmark(argv[2], max_timeline_jobs);
+  }
+  if ((argc == 3 || argc == 4) && strcmp(argv[1], "-s") == 0) {
+    for (int i = 0; i < POLICY_COUNT; i++) {
+      if (strcasecmp(argv[2], policies[i].name) == 0) {
+        return stream_jobs(argc == 4 ? argv[3] : NULL, &policies[i]);
+      }
+    }
+  }
+  if (argc < 2 || argv[1][0] == '-') {
+    printf("Usage: %s <job-file>\n"
+           "       %s -b <job-file> [max-timeline-jobs]\n"
+           "       %s -s fcfs|rr [job-file]\n",
+           argv[0], argv[0], argv[0]);
     return 1;
   }
 
   int err_code;
-  struct Job jobs[MAX_JOBS];
+  struct Job *jobs = NULL;
   unsigned int job_count = 0;
-  if ((err_code = read_jobs(argv[1], jobs, &job_count)) != 0) {
-    // Print messages outside of read_jobs since it should only return the code
-    switch (err_code) {
-    case -1:
-      printf("Failed to open file: %s\n", argv[1]);
-      break;
-    case -2:
-      printf("Invalid job file format.\n");
-      break;
-    case -3:
-      printf("Invalid arrival time (each job needs to be after the next).\n");
-      break;
-    }
+  if ((err_code = read_jobs(argv[1], &jobs, &job_count)) != 0) {
+    print_error(err_code, argv[1]);
     return err_code;
   }
 
   if (job_count == 0) {
     printf("No jobs found in file: %s\n", argv[1]);
+    free(jobs);
     return 1;
   }
 
-  fcfs(jobs, job_count);
-  printf("\n");
-  round_robin(jobs, job_count);
+  // Checkpoints from a previous run let an edited or extended trace skip
+  // re-simulating its unchanged start. A missing or stale file just means
+  // simulating from scratch.
+  char checkpoint_path[strlen(argv[1]) + sizeof(CHECKPOINT_SUFFIX)];
+  sprintf(checkpoint_path, "%s%s", argv[1], CHECKPOINT_SUFFIX);
+  struct Schedule schedules[POLICY_COUNT] = {0};
+  struct Checkpoints checkpoints[POLICY_COUNT] = {0};
+  load_checkpoints(checkpoint_path, schedules, checkpoints);
+
+  for (int i = 0; i < POLICY_COUNT && err_code == 0; i++) {
+    err_code = policies[i].simulate(jobs, job_count, &schedules[i],
+                                    &checkpoints[i]);
+  }
+
+  if (err_code != 0) {
+    print_error(err_code, argv[1]);
+  } else {
+    // Failing to save only makes the next run slower, so it is not an error
+    save_checkpoints(checkpoint_path, schedules, checkpoints);
 
+    for (int i = 0; i < POLICY_COUNT; i++) {
+      if (i > 0) {
+        printf("\n");
+      }
+      print_schedule(stdout, policies[i].name, jobs, job_count, &schedules[i]);
+    }
+  }
+
+  for (int i = 0; i < POLICY_COUNT; i++) {
+    free(schedules[i].segments);
+    free_checkpoints(&checkpoints[i]);
+  }
+  free(jobs);
+  return err_code;
+}
+
+/**
+ * Add a job to the back of the queue, growing it if needed. Returns 0 for
+ * success or -4 if out of memory.
+ */
+int queue_push(struct JobQueue *queue, struct ActiveJob active) {
+  if (queue->count == queue->capacity) {
+    unsigned int new_capacity =
+        queue->capacity == 0 ? INITIAL_CAPACITY : queue->capacity * 2;
+    struct ActiveJob *grown =
+        malloc(new_capacity * sizeof(struct ActiveJob));
+    if (grown == NULL) {
+      return -4; // Out of memory
+    }
+
+    // Unwrap the old items to the start of the new array
+    for (unsigned int i = 0; i < queue->count; i++) {
+      grown[i] = queue->items[(queue->front + i) % queue->capacity];
+    }
+    free(queue->items);
+    queue->items = grown;
+    queue->front = 0;
+    queue->capacity = new_capacity;
+  }
+
+  queue->items[(queue->front + queue->count) % queue->capacity] = active;
+  queue->count++;
+  return 0;
+}
+
+/**
+ * Remove the job at the front of the queue. The queue must not be empty.
+ */
+struct ActiveJob queue_pop(struct JobQueue *queue) {
+  struct ActiveJob active = queue->items[queue->front];
+  queue->front = (queue->front + 1) % queue->capacity;
+  queue->count--;
+  return active;
+}
+
+/**
+ * Run a job for length time units from the current time, printing its metrics
+ * if it finishes.
+ */
+void stream_run(struct Stream *stream, struct ActiveJob *active,
+                unsigned int length) {
+  if (stream->has_open && stream->open.job == active->id &&
+      stream->open.start + stream->open.length == stream->time) {
+    stream->open.length += length;
+  } else {
+    flush_segment(stream);
+    struct Segment segment = {stream->time, active->id, length};
+    stream->open = segment;
+    stream->open_name = active->job.name;
+    stream->has_open = 1;
+  }
+
+  stream->time += length;
+  active->remaining -= length;
+  if (active->remaining == 0) {
+    flush_segment(stream);
+    print_done(stream->out, active, stream->time);
+  }
+}
+
+/**
+ * Print the open segment, if any, as "run <id> <name> <start> <length>".
+ */
+void flush_segment(struct Stream *stream) {
+  if (stream->has_open) {
+    fprintf(stream->out, "run %u %c %llu %u\n", stream->open.job,
+            stream->open_name, stream->open.start, stream->open.length);
+    stream->has_open = 0;
+  }
+}
+
+/**
+ * Print the metrics of a finished job as
+ * "done <id> <name> <arrival> <finish> <turnaround> <waiting>".
+ */
+void print_done(FILE *out, struct ActiveJob *active,
+                unsigned long long finish_time) {
+  unsigned long long turnaround = finish_time - active->job.arrival_time;
+  fprintf(out, "done %u %c %u %llu %llu %llu\n", active->id, active->job.name,
+          active->job.arrival_time, finish_time, turnaround,
+          turnaround - active->job.duration);
+}
+
+/**
+ * Streaming FCFS. The front job never depends on later arrivals, so every
+ * ready job runs to completion right away.
+ */
+int fcfs_advance(struct Stream *stream, unsigned long long limit) {
+  // Unused since FCFS never waits for later arrivals
+  (void)limit;
+
+  while (stream->ready.count > 0) {
+    struct ActiveJob active = queue_pop(&stream->ready);
+    stream_run(stream, &active, active.remaining);
+  }
   return 0;
 }
 
 /**
- * Read jobs from a file and store them in an array along with the count.
- * Returns 0 for success, -1 if the file fails to open, -2 for invalid format,
- * or -3 for invalid arrival time sequence.
+ * Streaming Round Robin with quantum size of 1. Jobs arriving at the end of a
+ * quantum go before the re-enqueued job, so a quantum ending at limit holds its
+ * job until every arrival at limit has been read.
  */
-int read_jobs(char *path, struct Job *jobs, unsigned int *job_count) {
-  FILE *job_file = fopen(path, "r");
+int round_robin_advance(struct Stream *stream, unsigned long long limit) {
+  while (stream->time < limit) {
+    if (stream->has_held) {
+      stream->has_held = 0;
+      int res;
+      if ((res = queue_push(&stream->ready, stream->held)) != 0) {
+        return res;
+      }
+    }
+
+    if (stream->ready.count == 0) {
+      break;
+    }
+
+    struct ActiveJob active = queue_pop(&stream->ready);
+    stream_run(stream, &active, 1);
+    if (active.remaining > 0) {
+      stream->held = active;
+      stream->has_held = 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Schedule jobs as they are read from a file, FIFO, or stdin (if path is NULL)
+ * and print each segment and finished job as soon as it is known. Returns the
+ * same codes as read_jobs.
+ */
+int stream_jobs(char *path, struct Policy *policy) {
+  FILE *job_file = path == NULL ? stdin : fopen(path, "rb");
   if (job_file == NULL) {
-    return -1; // Failed to open file
+    print_error(-1, path);
+    return -1;
   }
 
-  // Read each line, but stop at MAX_JOBS to prevent overflow
-  for (int i = 0; i < MAX_JOBS; i++) {
-    struct Job new_job;
-    int res = fscanf(job_file, "%c%*[\t ]%u%*[\t ]%u%*[\n]", &new_job.name,
-                     &new_job.arrival_time, &new_job.duration);
+  // Regular files are read as fast as possible. Anything else is a live feed,
+  // so output is flushed after every job.
+  struct stat file_stat;
+  int live = fstat(fileno(job_file), &file_stat) != 0 ||
+             !S_ISREG(file_stat.st_mode);
+
+  struct Stream stream = {0};
+  stream.out = stdout;
+  printf("%s\n", policy->name);
 
-    if (res == EOF) {
-      *job_count = i;
+  int binary = detect_format(job_file);
+  int res = binary < 0 ? binary : 0;
+  unsigned int id = 0;
+  struct Job job;
+  while (res == 0 && (res = read_next_job(job_file, binary, &job)) == 1) {
+    // Job arrival order must be in increasing order
+    if (id > 0 && job.arrival_time < stream.last_arrival) {
+      res = -3; // Invalid arrival time
       break;
-    } else if (res < 3) {
-      fclose(job_file);
-      return -2; // Invalid format
     }
+    stream.last_arrival = job.arrival_time;
 
-    // Check job is valid based on last job
-    if (i > 0) {
-      struct Job last_job = jobs[i - 1];
-      // Job arrival order must be in increasing order
-      if (new_job.arrival_time < last_job.arrival_time) {
-        fclose(job_file);
-        return -3; // Invalid arrival time
+    // No more jobs can arrive before this one, so run everything up to it
+    if ((res = policy->advance(&stream, job.arrival_time)) != 0) {
+      break;
+    }
+
+    // The CPU is idle until this job arrives if nothing else is waiting
+    if (stream.ready.count == 0 && !stream.has_held &&
+        stream.time < job.arrival_time) {
+      stream.time = job.arrival_time;
+    }
+
+    // A job with no duration finishes once the CPU has caught up to it, which
+    // is its arrival for Round Robin but may be later for FCFS
+    struct ActiveJob active = {id++, job, job.duration};
+    if (job.duration == 0) {
+      // The open segment ends by now, so print it first to keep the output in
+      // time order. A Round Robin run continuing past it is split in two.
+      flush_segment(&stream);
+      print_done(stream.out, &active, stream.time);
+    } else {
+      if ((res = queue_push(&stream.ready, active)) != 0 ||
+          (res = policy->advance(&stream, job.arrival_time)) != 0) {
+        break;
       }
     }
 
-    jobs[i] = new_job;
+    // Make the output visible before possibly blocking on the next read
+    if (live) {
+      fflush(stream.out);
+    }
+  }
+
+  // At the end of the input nothing else arrives, so run every remaining job
+  if (res == 0) {
+    res = policy->advance(&stream, ULLONG_MAX);
+  }
+
+  flush_segment(&stream);
+  fflush(stream.out);
+  free(stream.ready.items);
+  if (job_file != stdin) {
+    fclose(job_file);
+  }
+  if (res != 0) {
+    print_error(res, path);
+  }
+  return res;
+}
+
+/**
+ * Print the message for an error code returned by the reading or scheduling
+ * functions.
+ */
+void print_error(int err_code, char *path) {
+  // Print messages outside of read_jobs since it should only return the code
+  switch (err_code) {
+  case -1:
+    printf("Failed to open file: %s\n", path);
+    break;
+  case -2:
+    printf("Invalid job file format.\n");
+    break;
+  case -3:
+    printf("Invalid arrival time (each job needs to be after the next).\n");
+    break;
+  case -4:
+    printf("Out of memory.\n");
+    break;
+  }
+}
+
+/**
+ * Parse a whole command line argument as a decimal count. Returns 0 for
+ * success or -1 if it is not a number or out of range.
+ */
+int parse_count(char *text, unsigned int *count) {
+  // strtoul accepts a sign and wraps negative numbers, so require a digit
+  if (!isdigit((unsigned char)text[0])) {
+    return -1;
+  }
+
+  char *end;
+  errno = 0;
+  unsigned long value = strtoul(text, &end, 10);
+  if (errno != 0 || *end != '\0' || value > UINT_MAX) {
+    return -1;
+  }
+  *count = value;
+  return 0;
+}
+
+/**
+ * Read jobs from a text or binary file into a newly allocated array along with
+ * the count. The caller frees the array. Returns 0 for success, -1 if the file
+ * fails to open, -2 for invalid format, -3 for invalid arrival time sequence,
+ * or -4 if out of memory.
+ */
+int read_jobs(char *path, struct Job **jobs, unsigned int *job_count) {
+  FILE *job_file = fopen(path, "rb");
+  if (job_file == NULL) {
+    return -1; // Failed to open file
+  }
+
+  *jobs = NULL;
+  *job_count = 0;
+  int res = detect_format(job_file);
+  if (res == 1) {
+    res = read_binary_jobs(job_file, jobs, job_count);
+  } else if (res == 0) {
+    res = read_text_jobs(job_file, jobs, job_count);
   }
 
   fclose(job_file);
+  if (res != 0) {
+    free(*jobs);
+    *jobs = NULL;
+    *job_count = 0;
+  }
+  return res;
+}
+
+/**
+ * Check if a job file is binary using only its first byte, so it also works on
+ * pipes. The magic is consumed for binary files. Returns 1 for binary, 0 for
+ * text, or -2 for an invalid magic.
+ */
+int detect_format(FILE *job_file) {
+  int first = getc(job_file);
+  if (first != (unsigned char)BINARY_MAGIC[0]) {
+    ungetc(first, job_file);
+    return 0;
+  }
+
+  char magic[BINARY_MAGIC_LEN - 1];
+  if (fread(magic, 1, BINARY_MAGIC_LEN - 1, job_file) != BINARY_MAGIC_LEN - 1 ||
+      memcmp(magic, BINARY_MAGIC + 1, BINARY_MAGIC_LEN - 1) != 0) {
+    return -2; // Invalid format
+  }
+  return 1;
+}
+
+/**
+ * Read a single job from a text or binary file. Returns 1 if a job was read, 0
+ * at the end of the file, or -2 for invalid format.
+ */
+int read_next_job(FILE *job_file, int binary, struct Job *job) {
+  if (binary) {
+    unsigned char record[BINARY_RECORD_SIZE];
+    size_t read_bytes = fread(record, 1, BINARY_RECORD_SIZE, job_file);
+    if (read_bytes == 0) {
+      return 0;
+    } else if (read_bytes < BINARY_RECORD_SIZE) {
+      return -2; // Invalid format
+    }
+    decode_record(record, job);
+    return 1;
+  }
+
+  // Read a whole line first so a live feed is handled as soon as each line
+  // arrives, instead of blocking to see if more newlines follow. Blank lines
+  // between jobs are skipped.
+  char line[MAX_LINE_LENGTH];
+  do {
+    if (fgets(line, sizeof(line), job_file) == NULL) {
+      return 0;
+    }
+  } while (line[0] == '\n');
+
+  int end = 0;
+  if (sscanf(line, "%c%*[\t ]%u%*[\t ]%u%n", &job->name, &job->arrival_time,
+             &job->duration, &end) < 3 ||
+      (line[end] != '\n' && line[end] != '\0')) {
+    return -2; // Invalid format
+  }
+  return 1;
+}
+
+/**
+ * Read text jobs ("<name> <arrival> <duration>" per line) until EOF. Returns
+ * the same codes as read_jobs.
+ */
+int read_text_jobs(FILE *job_file, struct Job **jobs, unsigned int *job_count) {
+  unsigned int capacity = 0;
+  struct Job new_job;
+  int res;
+  while ((res = read_next_job(job_file, 0, &new_job)) == 1) {
+    if ((res = add_job(jobs, job_count, &capacity, new_job)) != 0) {
+      return res;
+    }
+  }
+  return res;
+}
+
+/**
+ * Read binary job records after the magic until EOF. Records are read in
+ * chunks since this is the fast path for large traces. Returns the same codes
+ * as read_jobs.
+ */
+int read_binary_jobs(FILE *job_file, struct Job **jobs,
+                     unsigned int *job_count) {
+  unsigned char buffer[BINARY_CHUNK_RECORDS * BINARY_RECORD_SIZE];
+  unsigned int capacity = 0;
+  size_t read_bytes;
+  while ((read_bytes = fread(buffer, 1, sizeof(buffer), job_file)) > 0) {
+    // A truncated record means the file is corrupt
+    if (read_bytes % BINARY_RECORD_SIZE != 0) {
+      return -2; // Invalid format
+    }
+
+    for (size_t i = 0; i < read_bytes; i += BINARY_RECORD_SIZE) {
+      struct Job new_job;
+      decode_record(buffer + i, &new_job);
+
+      int res;
+      if ((res = add_job(jobs, job_count, &capacity, new_job)) != 0) {
+        return res;
+      }
+    }
+  }
   return 0;
 }
 
 /**
- * Performs FCFS scheduling on the jobs and prints the results.
+ * Decode a binary job record.
  */
-void fcfs(struct Job *jobs, unsigned int count) {
-  printf("FCFS\n");
+void decode_record(unsigned char *record, struct Job *job) {
+  job->name = (char)record[0];
+  job->arrival_time = record[1] | record[2] << 8 | record[3] << 16 |
+                      (unsigned int)record[4] << 24;
+  job->duration = record[5] | record[6] << 8 | record[7] << 16 |
+                  (unsigned int)record[8] << 24;
+}
 
-  // Print header
-  for (int i = 0; i < count; i++) {
-    struct Job job = jobs[i];
-    printf("%c", job.name);
+/**
+ * Make room for one more item in a growable array, doubling its capacity when
+ * it is full. Returns 0 for success or -4 if out of memory.
+ */
+int grow_array(void **items, unsigned int count, unsigned int *capacity,
+               size_t item_size) {
+  if (count < *capacity) {
+    return 0;
+  }
+
+  unsigned int new_capacity = *capacity == 0 ? INITIAL_CAPACITY : *capacity * 2;
+  void *grown = realloc(*items, new_capacity * item_size);
+  if (grown == NULL) {
+    return -4; // Out of memory
+  }
+  *items = grown;
+  *capacity = new_capacity;
+  return 0;
+}
+
+/**
+ * Append a job to the array, growing it if needed. Returns 0 for success, -3
+ * if the job arrives before the last one, or -4 if out of memory.
+ */
+int add_job(struct Job **jobs, unsigned int *count, unsigned int *capacity,
+            struct Job new_job) {
+  // Job arrival order must be in increasing order
+  if (*count > 0 && new_job.arrival_time < (*jobs)[*count - 1].arrival_time) {
+    return -3; // Invalid arrival time
+  }
+
+  int res;
+  if ((res = grow_array((void **)jobs, *count, capacity,
+                        sizeof(struct Job))) != 0) {
+    return res;
+  }
+
+  (*jobs)[(*count)++] = new_job;
+  return 0;
+}
+
+/**
+ * Record that a job ran from start for length time units. Extends the last
+ * segment instead if it is the same job and ends at start. Returns 0 for
+ * success or -4 if out of memory.
+ */
+int add_segment(struct Schedule *schedule, unsigned int job,
+                unsigned long long start, unsigned int length) {
+  if (schedule->count > 0) {
+    struct Segment *last = &schedule->segments[schedule->count - 1];
+    if (last->job == job && last->start + last->length == start) {
+      last->length += length;
+      return 0;
+    }
+  }
+
+  int res;
+  if ((res = grow_array((void **)&schedule->segments, schedule->count,
+                        &schedule->capacity, sizeof(struct Segment))) != 0) {
+    return res;
+  }
+
+  struct Segment segment = {start, job, length};
+  schedule->segments[schedule->count++] = segment;
+  return 0;
+}
+
+/**
+ * Extend an FNV-1a style hash over the name, arrival time, and duration of
+ * jobs.
+ */
+unsigned long long hash_jobs(unsigned long long hash, struct Job *jobs,
+                             unsigned int count) {
+  for (unsigned int i = 0; i < count; i++) {
+    // Mixing in whole fields instead of bytes keeps this cheap on long traces
+    hash = (hash ^ (unsigned char)jobs[i].name) * HASH_PRIME;
+    hash = (hash ^ jobs[i].arrival_time) * HASH_PRIME;
+    hash = (hash ^ jobs[i].duration) * HASH_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * Returns whether enough jobs have been admitted since the last checkpoint to
+ * take another one.
+ */
+int checkpoint_due(struct Checkpoints *checkpoints, unsigned int next_job,
+                   unsigned int queued) {
+  unsigned int last_next_job =
+      checkpoints->count > 0
+          ? checkpoints->items[checkpoints->count - 1].next_job
+          : 0;
+  return next_job - last_next_job >= CHECKPOINT_INTERVAL + queued;
+}
+
+/**
+ * Append a checkpoint given its time, next_job, finished, arrival_bound, and
+ * queued fields. Its queued jobs must already be at the end of queued_jobs.
+ * Returns 0 for success or -4 if out of memory.
+ */
+int add_checkpoint(struct Checkpoints *checkpoints, struct Job *jobs,
+                   struct Schedule *schedule, struct Checkpoint checkpoint) {
+  // Extend the previous checkpoint's hash over the jobs admitted since
+  unsigned long long hash = HASH_SEED;
+  unsigned int hashed = 0;
+  if (checkpoints->count > 0) {
+    hash = checkpoints->items[checkpoints->count - 1].job_hash;
+    hashed = checkpoints->items[checkpoints->count - 1].next_job;
   }
-  printf("\n");
+  checkpoint.job_hash =
+      hash_jobs(hash, jobs + hashed, checkpoint.next_job - hashed);
+
+  checkpoint.segment_count = schedule->count;
+  checkpoint.last_length =
+      schedule->count > 0 ? schedule->segments[schedule->count - 1].length : 0;
+  checkpoint.queue_offset = checkpoints->queued_count - checkpoint.queued;
+
+  int res;
+  if ((res = grow_array((void **)&checkpoints->items, checkpoints->count,
+                        &checkpoints->capacity,
+                        sizeof(struct Checkpoint))) != 0) {
+    return res;
+  }
+  checkpoints->items[checkpoints->count++] = checkpoint;
+  return 0;
+}
+
+/**
+ * Find the latest checkpoint from a previous run that is still valid for jobs,
+ * and drop everything recorded after it from the schedule and checkpoints.
+ * Returns 1 and copies it to resume if found, or 0 to start from scratch.
+ */
+int resume_checkpoint(struct Job *jobs, unsigned int count,
+                      struct Schedule *schedule,
+                      struct Checkpoints *checkpoints,
+                      struct Checkpoint *resume) {
+  unsigned long long hash = HASH_SEED;
+  unsigned int hashed = 0, valid = 0;
+
+  // Checkpoints cover a growing prefix of the jobs, so once one is invalid
+  // every later one is too
+  for (; valid < checkpoints->count; valid++) {
+    struct Checkpoint *checkpoint = &checkpoints->items[valid];
+    if (checkpoint->next_job > count ||
+        checkpoint->segment_count > schedule->count) {
+      break;
+    }
+
+    hash = hash_jobs(hash, jobs + hashed, checkpoint->next_job - hashed);
+    hashed = checkpoint->next_job;
+    if (hash != checkpoint->job_hash) {
+      break;
+    }
+
+    // An unadmitted job now arriving too early would have changed the state
+    if (checkpoint->next_job < count &&
+        jobs[checkpoint->next_job].arrival_time < checkpoint->arrival_bound) {
+      break;
+    }
+
+    // Queued jobs cannot have more time left than their duration
+    unsigned int queued = 0;
+    for (; queued < checkpoint->queued; queued++) {
+      struct QueuedJob *queued_job =
+          &checkpoints->queued_jobs[checkpoint->queue_offset + queued];
+      if (queued_job->remaining > jobs[queued_job->job].duration) {
+        break;
+      }
+    }
+    if (queued < checkpoint->queued) {
+      break;
+    }
+  }
+
+  checkpoints->count = valid;
+  if (valid == 0) {
+    checkpoints->queued_count = 0;
+    schedule->count = 0;
+    return 0;
+  }
+
+  *resume = checkpoints->items[valid - 1];
+  checkpoints->queued_count = resume->queue_offset + resume->queued;
+  schedule->count = resume->segment_count;
+  if (schedule->count > 0) {
+    schedule->segments[schedule->count - 1].length = resume->last_length;
+  }
+  return 1;
+}
+
+/**
+ * Extend a hash over raw bytes, mixing in 8 bytes at a time so large checkpoint
+ * files stay cheap to verify.
+ */
+unsigned long long hash_bytes(unsigned long long hash, void *bytes,
+                              size_t size) {
+  unsigned char *data = bytes;
+  size_t i = 0;
+  for (; i + sizeof(unsigned long long) <= size;
+       i += sizeof(unsigned long long)) {
+    unsigned long long word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * HASH_PRIME;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * HASH_PRIME;
+  }
+  return hash;
+}
+
+/**
+ * Write an array to a file and add it to the checksum. Empty arrays may be
+ * NULL. Returns 1 if every item was written, otherwise 0.
+ */
+int write_array(void *items, size_t item_size, unsigned int count,
+                FILE *file, unsigned long long *checksum) {
+  if (count == 0) {
+    return 1;
+  }
+  *checksum = hash_bytes(*checksum, items, item_size * count);
+  return fwrite(items, item_size, count, file) == count;
+}
+
+/**
+ * Read an array from a file and add it to the checksum. Empty arrays may be
+ * NULL. Returns 1 if every item was read, otherwise 0.
+ */
+int read_array(void *items, size_t item_size, unsigned int count, FILE *file,
+               unsigned long long *checksum) {
+  if (count == 0) {
+    return 1;
+  }
+  if (fread(items, item_size, count, file) != count) {
+    return 0;
+  }
+  *checksum = hash_bytes(*checksum, items, item_size * count);
+  return 1;
+}
+
+/**
+ * Write the schedules and checkpoints of every policy to a checkpoint file.
+ * The file is written under a temporary name first so an interrupted save
+ * never leaves a corrupt file. Returns 0 for success or -1 if it fails.
+ */
+int save_checkpoints(char *path, struct Schedule *schedules,
+                     struct Checkpoints *checkpoints) {
+  char temp_path[strlen(path) + sizeof(".tmp")];
+  sprintf(temp_path, "%s.tmp", path);
+  FILE *file = fopen(temp_path, "wb");
+  if (file == NULL) {
+    return -1; // Failed to open file
+  }
+
+  // Everything after the magic is covered by a checksum at the end of the file
+  unsigned long long checksum = HASH_SEED;
+  unsigned int policy_count = POLICY_COUNT;
+  int ok = fwrite(CHECKPOINT_MAGIC, 1, CHECKPOINT_MAGIC_LEN, file) ==
+               CHECKPOINT_MAGIC_LEN &&
+           write_array(&policy_count, sizeof(unsigned int), 1, file, &checksum);
+  for (int i = 0; i < POLICY_COUNT && ok; i++) {
+    unsigned int counts[3] = {schedules[i].count, checkpoints[i].count,
+                              checkpoints[i].queued_count};
+    ok = write_array(counts, sizeof(unsigned int), 3, file, &checksum) &&
+         write_array(schedules[i].segments, sizeof(struct Segment), counts[0],
+                     file, &checksum) &&
+         write_array(checkpoints[i].items, sizeof(struct Checkpoint),
+                     counts[1], file, &checksum) &&
+         write_array(checkpoints[i].queued_jobs, sizeof(struct QueuedJob),
+                     counts[2], file, &checksum);
+  }
+  ok = ok && fwrite(&checksum, sizeof(checksum), 1, file) == 1;
+
+  if (fclose(file) != 0 || !ok || rename(temp_path, path) != 0) {
+    remove(temp_path);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Read the schedules and checkpoints of every policy from a checkpoint file.
+ * Returns 0 for success, -1 if the file fails to open, -2 if it is invalid, or
+ * -4 if out of memory. On failure, everything is left empty.
+ */
+int load_checkpoints(char *path, struct Schedule *schedules,
+                     struct Checkpoints *checkpoints) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return -1; // Failed to open file
+  }
+
+  char magic[CHECKPOINT_MAGIC_LEN];
+  unsigned long long checksum = HASH_SEED, saved_checksum;
+  unsigned int policy_count;
+  int res = 0;
+  if (fread(magic, 1, CHECKPOINT_MAGIC_LEN, file) != CHECKPOINT_MAGIC_LEN ||
+      memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN) != 0 ||
+      !read_array(&policy_count, sizeof(unsigned int), 1, file, &checksum) ||
+      policy_count != POLICY_COUNT) {
+    res = -2; // Invalid format
+  }
+
+  for (int i = 0; i < POLICY_COUNT && res == 0; i++) {
+    unsigned int counts[3];
+    if (!read_array(counts, sizeof(unsigned int), 3, file, &checksum)) {
+      res = -2; // Invalid format
+      break;
+    }
+
+    schedules[i].segments = malloc(counts[0] * sizeof(struct Segment));
+    checkpoints[i].items = malloc(counts[1] * sizeof(struct Checkpoint));
+    checkpoints[i].queued_jobs = malloc(counts[2] * sizeof(struct QueuedJob));
+    if ((counts[0] > 0 && schedules[i].segments == NULL) ||
+        (counts[1] > 0 && checkpoints[i].items == NULL) ||
+        (counts[2] > 0 && checkpoints[i].queued_jobs == NULL)) {
+      res = -4; // Out of memory
+      break;
+    }
+    schedules[i].count = schedules[i].capacity = counts[0];
+    checkpoints[i].count = checkpoints[i].capacity = counts[1];
+    checkpoints[i].queued_count = checkpoints[i].queued_capacity = counts[2];
+
+    if (!read_array(schedules[i].segments, sizeof(struct Segment), counts[0],
+                    file, &checksum) ||
+        !read_array(checkpoints[i].items, sizeof(struct Checkpoint), counts[1],
+                    file, &checksum) ||
+        !read_array(checkpoints[i].queued_jobs, sizeof(struct QueuedJob),
+                    counts[2], file, &checksum)) {
+      res = -2; // Invalid format
+    }
+  }
+
+  // The checksum catches any changed bytes, and the consistency check keeps a
+  // file that was deliberately given a matching checksum from indexing out of
+  // bounds
+  if (res == 0 &&
+      (fread(&saved_checksum, sizeof(saved_checksum), 1, file) != 1 ||
+       saved_checksum != checksum || getc(file) != EOF)) {
+    res = -2; // Invalid format
+  }
+  for (int i = 0; i < POLICY_COUNT && res == 0; i++) {
+    if (!check_checkpoints(&schedules[i], &checkpoints[i])) {
+      res = -2; // Invalid format
+    }
+  }
+
+  fclose(file);
+  if (res != 0) {
+    for (int i = 0; i < POLICY_COUNT; i++) {
+      free(schedules[i].segments);
+      free_checkpoints(&checkpoints[i]);
+      struct Schedule empty = {NULL, 0, 0};
+      schedules[i] = empty;
+    }
+  }
+  return res;
+}
+
+/**
+ * Check that checkpoints read from a file are consistent with each other and
+ * with the schedule before any of their indexes are trusted. Anything that
+ * depends on the jobs themselves is checked by resume_checkpoint. Returns 1 if
+ * they are valid, otherwise 0.
+ */
+int check_checkpoints(struct Schedule *schedule,
+                      struct Checkpoints *checkpoints) {
+  if (checkpoints->count == 0) {
+    return 1;
+  }
+
+  // Marks jobs seen in one checkpoint's queue, since a job queued twice would
+  // run past its remaining duration
+  unsigned int max_next_job = 0;
+  for (unsigned int i = 0; i < checkpoints->count; i++) {
+    if (checkpoints->items[i].next_job > max_next_job) {
+      max_next_job = checkpoints->items[i].next_job;
+    }
+  }
+  unsigned char *seen = calloc((size_t)max_next_job + 1, 1);
+  if (seen == NULL) {
+    return 0;
+  }
+
+  struct Checkpoint previous = {0};
+  unsigned long long segment_end = 0;
+  int valid = 1;
+  for (unsigned int i = 0; i < checkpoints->count && valid; i++) {
+    struct Checkpoint *checkpoint = &checkpoints->items[i];
+
+    // Checkpoints only move forward, every admitted job is either finished or
+    // queued, and each one's queued jobs directly follow the previous one's
+    valid = checkpoint->time >= previous.time &&
+            checkpoint->next_job >= previous.next_job &&
+            checkpoint->finished >= previous.finished &&
+            checkpoint->finished <= checkpoint->next_job &&
+            checkpoint->queued ==
+                checkpoint->next_job - checkpoint->finished &&
+            checkpoint->segment_count >= previous.segment_count &&
+            checkpoint->segment_count <= schedule->count &&
+            checkpoint->queue_offset ==
+                previous.queue_offset + previous.queued &&
+            checkpoint->queued <=
+                checkpoints->queued_count - checkpoint->queue_offset;
+
+    // Queued jobs must have been admitted, be queued once, and have time left
+    struct QueuedJob *queued =
+        valid ? checkpoints->queued_jobs + checkpoint->queue_offset : NULL;
+    unsigned int queued_count = valid ? checkpoint->queued : 0, marked = 0;
+    for (; marked < queued_count; marked++) {
+      if (queued[marked].job >= checkpoint->next_job ||
+          seen[queued[marked].job] || queued[marked].remaining == 0) {
+        valid = 0;
+        break;
+      }
+      seen[queued[marked].job] = 1;
+    }
+    // Clear only the marks that were set so each checkpoint stays linear
+    while (marked-- > 0) {
+      seen[queued[marked].job] = 0;
+    }
+
+    // Segments before the checkpoint must be for admitted jobs and in order
+    for (unsigned int k = previous.segment_count;
+         valid && k < checkpoint->segment_count; k++) {
+      struct Segment *segment = &schedule->segments[k];
+      valid = segment->job < checkpoint->next_job && segment->length > 0 &&
+              segment->start >= segment_end;
+      segment_end = (unsigned long long)segment->start + segment->length;
+    }
+
+    // The last segment may have grown after the checkpoint, but not shrunk
+    if (valid && checkpoint->segment_count > 0) {
+      struct Segment *last = &schedule->segments[checkpoint->segment_count - 1];
+      valid = checkpoint->last_length > 0 &&
+              checkpoint->last_length <= last->length &&
+              (unsigned long long)last->start + checkpoint->last_length <=
+                  checkpoint->time;
+    }
+
+    previous = *checkpoint;
+  }
+
+  free(seen);
+  return valid;
+}
+
+/**
+ * Free a checkpoint list and leave it empty.
+ */
+void free_checkpoints(struct Checkpoints *checkpoints) {
+  free(checkpoints->items);
+  free(checkpoints->queued_jobs);
+  struct Checkpoints empty = {0};
+  *checkpoints = empty;
+}
+
+/**
+ * Performs FCFS scheduling on the jobs.
+ */
+int fcfs(struct Job *jobs, unsigned int count, struct Schedule *schedule,
+         struct Checkpoints *checkpoints) {
+  // FCFS state is just the time and the next job, and later arrivals never
+  // change it, so checkpoints have no arrival bound
+  struct Checkpoint resume = {0};
+  resume_checkpoint(jobs, count, schedule, checkpoints, &resume);
 
   // According to the requirements, the jobs are already sorted by arrival time
-  // So we can just iterate through the jobs and print the details
-  for (int job_idx = 0, time = 0; job_idx < count; job_idx++) {
+  // So each job runs to completion in file order
+  unsigned long long time = resume.time;
+  for (unsigned int job_idx = resume.next_job; job_idx < count; job_idx++) {
     struct Job job = jobs[job_idx];
+    int res;
 
-    // Print empty spaces if there is a gap between jobs
-    for (; time < job.arrival_time; time++) {
-      printf("\n");
+    if (checkpoint_due(checkpoints, job_idx, 0)) {
+      struct Checkpoint checkpoint = {time, job_idx, job_idx};
+      if ((res = add_checkpoint(checkpoints, jobs, schedule, checkpoint)) !=
+          0) {
+        return res;
+      }
     }
 
-    for (int x_idx = 0; x_idx < job.duration; x_idx++) {
-      // Pad X with spaces based on the job index
-      printf("%*sX\n", job_idx, "");
+    // The CPU is idle if there is a gap between jobs
+    if (time < job.arrival_time) {
+      time = job.arrival_time;
+    }
+
+    if (job.duration > 0) {
+      if ((res = add_segment(schedule, job_idx, time, job.duration)) != 0) {
+        return res;
+      }
     }
 
     time += job.duration;
   }
+  schedule->end = time;
+  return 0;
+}
+
+/**
+ * Enqueues every job that has arrived by the current time. Jobs with no
+ * duration finish immediately instead.
+ */
+void enqueue_arrivals(struct RoundRobinState *state, struct Job *jobs,
+                      unsigned int count) {
+  for (; state->next_job < count &&
+         jobs[state->next_job].arrival_time <= state->time;
+       state->next_job++) {
+    unsigned int job_idx = state->next_job;
+    state->durations[job_idx] = jobs[job_idx].duration;
+    if (state->durations[job_idx] == 0) {
+      state->finished++;
+      continue;
+    }
+    state->queue[state->rear] = job_idx;
+    state->rear = (state->rear + 1) % count;
+    state->queued++;
+  }
 }
 
 /**
- * Performs Round Robin scheduling on the jobs and prints the results.
- * Assumes quantum size of 1.
+ * Performs Round Robin scheduling on the jobs. Assumes quantum size of 1.
  */
-void round_robin(struct Job *jobs, unsigned int count) {
-  printf("RR\n");
+int round_robin(struct Job *jobs, unsigned int count,
+                struct Schedule *schedule, struct Checkpoints *checkpoints) {
+  // Remaining durations are indexed by job so the job array is not modified.
+  // Each job is in the queue at most once, so count slots are enough.
+  struct RoundRobinState state = {0};
+  state.durations = malloc(count * sizeof(unsigned int));
+  state.queue = malloc(count * sizeof(unsigned int));
+  if (state.durations == NULL || state.queue == NULL) {
+    free(state.durations);
+    free(state.queue);
+    return -4; // Out of memory
+  }
 
-  // Print header
-  for (int i = 0; i < count; i++) {
-    struct Job job = jobs[i];
-    printf("%c", job.name);
-  }
-  printf("\n");
-
-  int durations[count], total_duration = 0;
-
-  // Preprocess job durations
-  for (int i = 0; i < count; i++) {
-    durations[i] = jobs[i].duration;
-    total_duration += jobs[i].duration;
-    if (i > 0) {
-      int gap = jobs[i].arrival_time -
-                (jobs[i - 1].arrival_time + jobs[i - 1].duration);
-      if (gap > 0) {
-        total_duration += gap;
-      }
+  // Restore the queue and remaining durations of a valid checkpoint
+  struct Checkpoint resume;
+  if (resume_checkpoint(jobs, count, schedule, checkpoints, &resume)) {
+    state.time = resume.time;
+    state.next_job = resume.next_job;
+    state.finished = resume.finished;
+    for (unsigned int i = 0; i < resume.queued; i++) {
+      struct QueuedJob queued =
+          checkpoints->queued_jobs[resume.queue_offset + i];
+      state.durations[queued.job] = queued.remaining;
+      state.queue[state.rear] = queued.job;
+      state.rear = (state.rear + 1) % count;
+      state.queued++;
     }
   }
 
-  // Job index 0 is guaranteed to be running first
-  int queue[count];
-  int front = 0, rear = 1;
-  int next_job = 1;
-  queue[0] = 0;
+  int res = 0;
+  while (state.finished < count) {
+    // Every admitted job is either finished or queued here, so this is a
+    // consistent point to save
+    if (checkpoint_due(checkpoints, state.next_job, state.queued) &&
+        (res = save_round_robin_state(&state, count, jobs, schedule,
+                                      checkpoints)) != 0) {
+      break;
+    }
+
+    if (state.queued == 0) {
+      // Skip ahead to the next arrival since nothing is waiting
+      if (jobs[state.next_job].arrival_time > state.time) {
+        state.time = jobs[state.next_job].arrival_time;
+      }
+      enqueue_arrivals(&state, jobs, count);
+      continue;
+    }
 
-  for (int i = 0; i < total_duration; i++) {
-    int job_idx = -1;
+    // Run the front job for one quantum
+    unsigned int job_idx = state.queue[state.front];
+    state.front = (state.front + 1) % count;
+    state.queued--;
 
-    // Dequeue job if it exists
-    if (front != rear) {
-      job_idx = queue[front];
-      front = (front + 1) % count;
+    if ((res = add_segment(schedule, job_idx, state.time, 1)) != 0) {
+      break;
+    }
+    state.durations[job_idx]--;
+    state.time++;
 
-      durations[job_idx]--;
-      printf("%*sX\n", job_idx, "");
+    // New jobs go before the re-enqueued job
+    enqueue_arrivals(&state, jobs, count);
+
+    // Re-enqueue job
+    if (state.durations[job_idx] > 0) {
+      state.queue[state.rear] = job_idx;
+      state.rear = (state.rear + 1) % count;
+      state.queued++;
     } else {
-      printf("\n");
+      state.finished++;
     }
+  }
 
-    // Enqueue next job if it arrives next
-    if (next_job < count && jobs[next_job].arrival_time == i + 1) {
-      queue[rear] = next_job;
-      rear = (rear + 1) % count;
-      next_job++;
+  schedule->end = state.time;
+  free(state.durations);
+  free(state.queue);
+  return res;
+}
+
+/**
+ * Save a Round Robin checkpoint with the queue contents in order. Returns 0
+ * for success or -4 if out of memory.
+ */
+int save_round_robin_state(struct RoundRobinState *state, unsigned int count,
+                           struct Job *jobs, struct Schedule *schedule,
+                           struct Checkpoints *checkpoints) {
+  int res;
+  for (unsigned int i = 0; i < state->queued; i++) {
+    if ((res = grow_array((void **)&checkpoints->queued_jobs,
+                          checkpoints->queued_count,
+                          &checkpoints->queued_capacity,
+                          sizeof(struct QueuedJob))) != 0) {
+      return res;
     }
+    unsigned int job_idx = state->queue[(state->front + i) % count];
+    struct QueuedJob queued = {job_idx, state->durations[job_idx]};
+    checkpoints->queued_jobs[checkpoints->queued_count++] = queued;
+  }
 
-    // Re-enqueue job
-    if (job_idx >= 0 && durations[job_idx] > 0) {
-      queue[rear] = job_idx;
-      rear = (rear + 1) % count;
+  // Jobs arriving at or before the current time would already be queued
+  struct Checkpoint checkpoint = {state->time, state->next_job,
+                                  state->finished, state->time + 1};
+  checkpoint.queued = state->queued;
+  return add_checkpoint(checkpoints, jobs, schedule, checkpoint);
+}
+
+/**
+ * Prints a schedule vertically, one line per time unit, with an X in the
+ * column of the running job.
+ */
+void print_schedule(FILE *out, char *title, struct Job *jobs,
+                    unsigned int count, struct Schedule *schedule) {
+  fprintf(out, "%s\n", title);
+
+  // Print header
+  for (unsigned int i = 0; i < count; i++) {
+    fputc(jobs[i].name, out);
+  }
+  fputc('\n', out);
+
+  unsigned long long time = 0;
+  for (unsigned int i = 0; i < schedule->count; i++) {
+    struct Segment segment = schedule->segments[i];
+
+    // Print empty lines while the CPU is idle
+    for (; time < segment.start; time++) {
+      fputc('\n', out);
+    }
+
+    for (unsigned int x_idx = 0; x_idx < segment.length; x_idx++) {
+      // Pad X with spaces based on the job index
+      fprintf(out, "%*sX\n", (int)segment.job, "");
+    }
+
+    time += segment.length;
+  }
+
+  // Jobs with no duration still keep the timeline going until they arrive
+  for (; time < schedule->end; time++) {
+    fputc('\n', out);
+  }
+}
+
+/**
+ * Prints a schedule as one "run <id> <name> <start> <length>" line per
+ * segment, where <id> is the job's position in the trace.
+ */
+void print_segments(FILE *out, struct Job *jobs, struct Schedule *schedule) {
+  for (unsigned int i = 0; i < schedule->count; i++) {
+    struct Segment segment = schedule->segments[i];
+    fprintf(out, "run %u %c %llu %u\n", segment.job, jobs[segment.job].name,
+            segment.start, segment.length);
+  }
+}
+
+/**
+ * Returns the seconds elapsed since start.
+ */
+double elapsed_since(struct timespec start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * Prints one benchmark row with throughput and the process's peak memory so
+ * far. The peak is a high-water mark, so it includes every earlier phase.
+ */
+void print_bench_row(char *phase, char *policy, unsigned int count,
+                     double seconds) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  double rate = seconds > 0 ? count / seconds : 0;
+  printf("%-8s %-6s %10u %12.6f %14.0f %10ld\n", phase, policy, count,
+         seconds, rate, usage.ru_maxrss);
+}
+
+/**
+ * Times parsing, then simulation and output for each policy separately.
+ * Output is written to /dev/null so terminal speed is not measured. The
+ * segment list is always timed, and the timeline only up to max_timeline_jobs
+ * (0 for no limit).
+ */
+int run_benchmark(char *path, unsigned int max_timeline_jobs) {
+  struct timespec start;
+  int err_code;
+  struct Job *jobs = NULL;
+  unsigned int job_count = 0;
+
+  printf("%-8s %-6s %10s %12s %14s %10s\n", "phase", "policy", "jobs",
+         "seconds", "jobs/sec", "max_rss_kb");
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if ((err_code = read_jobs(path, &jobs, &job_count)) != 0) {
+    print_error(err_code, path);
+    return err_code;
+  }
+  print_bench_row("parse", "-", job_count, elapsed_since(start));
+
+  if (job_count == 0) {
+    printf("No jobs found in file: %s\n", path);
+    free(jobs);
+    return 1;
+  }
+
+  FILE *null_out = fopen("/dev/null", "w");
+  if (null_out == NULL) {
+    free(jobs);
+    return -1;
+  }
+
+  for (int i = 0; i < POLICY_COUNT; i++) {
+    struct Schedule schedule = {NULL, 0, 0};
+    struct Checkpoints checkpoints = {0};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if ((err_code = policies[i].simulate(jobs, job_count, &schedule,
+                                         &checkpoints)) != 0) {
+      free(schedule.segments);
+      free_checkpoints(&checkpoints);
+      print_error(err_code, path);
+      break;
+    }
+    print_bench_row("simulate", policies[i].name, job_count,
+                    elapsed_since(start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    print_segments(null_out, jobs, &schedule);
+    fflush(null_out);
+    print_bench_row("segments", policies[i].name, job_count,
+                    elapsed_since(start));
+
+    if (max_timeline_jobs == 0 || job_count <= max_timeline_jobs) {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      print_schedule(null_out, policies[i].name, jobs, job_count, &schedule);
+      fflush(null_out);
+      print_bench_row("timeline", policies[i].name, job_count,
+                      elapsed_since(start));
+    } else {
+      printf("%-8s %-6s %10u %12s\n", "timeline", policies[i].name,
+             job_count, "skipped");
     }
+    free(schedule.segments);
+    free_checkpoints(&checkpoints);
   }
+
+  fclose(null_out);
+  free(jobs);
+  return err_code;
 }